@@ -839,7 +839,10 @@ qint64 QProcess::writeData(const char *data, qint64 len)
     }
 
     if (!d->stdinChannel.writer) {
-        d->stdinChannel.writer = new QWindowsPipeWriter(d->stdinChannel.pipe[1], this);
+        // The stdin write end belongs to this process alone, so the writer
+        // may bind it to the thread pool.
+        d->stdinChannel.writer = new QWindowsPipeWriter(d->stdinChannel.pipe[1],
+                                                        QWindowsPipeWriter::ExclusiveHandle, this);
         QObjectPrivate::connect(d->stdinChannel.writer, &QWindowsPipeWriter::bytesWritten,
                                 d, &QProcessPrivate::_q_bytesWritten);
     }
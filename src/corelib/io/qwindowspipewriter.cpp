@@ -40,36 +40,163 @@
 
 #include "qwindowspipewriter_p.h"
 #include <qcoreapplication.h>
+#include <qpointer.h>
 #include <QMutexLocker>
 
 QT_BEGIN_NAMESPACE
 
-QWindowsPipeWriter::QWindowsPipeWriter(HANDLE pipeWriteEnd, QObject *parent)
+// Upper bound on the number of bytes flattened into a single submission
+// when the ring buffer holds more than one chunk.
+static const qint64 maxGatherSize = 65536;
+
+// Arrays at least this big bypass the ring buffer and are submitted from
+// their own storage.
+static const qint64 minPassThroughSize = QRINGBUFFER_CHUNKSIZE;
+
+// Number of bytesWritten() emissions a single consumePendingAndEmit() call
+// may perform before leaving the rest to a posted event, so that a
+// continuously writing slot cannot starve the event loop.
+static const int maxEmitCycles = 4;
+
+// The manual-reset sync event outlives any single write sequence, and
+// short-lived writers (one per QProcess channel) would otherwise create
+// and destroy one kernel event per lifecycle, so the events are recycled
+// through a process-wide pool. The thread pool I/O object is bound to the
+// pipe handle and therefore cannot be pooled.
+class QWindowsPipeWriterPool
+{
+public:
+    ~QWindowsPipeWriterPool()
+    {
+        for (HANDLE event : qAsConst(events))
+            CloseHandle(event);
+    }
+
+    HANDLE acquire()
+    {
+        {
+            QMutexLocker locker(&poolMutex);
+            if (!events.isEmpty())
+                return events.takeLast();
+        }
+        return CreateEvent(NULL, TRUE, FALSE, NULL);
+    }
+
+    void release(HANDLE event)
+    {
+        ResetEvent(event);
+        QMutexLocker locker(&poolMutex);
+        if (events.size() < MaxPoolSize) {
+            events.append(event);
+            return;
+        }
+        locker.unlock();
+        CloseHandle(event);
+    }
+
+private:
+    enum { MaxPoolSize = 64 };
+
+    QMutex poolMutex;
+    QList<HANDLE> events;
+};
+
+Q_GLOBAL_STATIC(QWindowsPipeWriterPool, pipeWriterPool)
+
+// startAsyncWriteLocked() posts one of these per completion round trip.
+// The event loop takes ownership of posted events and deletes them after
+// delivery, so the event must live on the heap; recycling the storage of
+// the most recently deleted instance avoids going through the allocator
+// for every completion. winEventActPosted already keeps the number of
+// outstanding events low, so a single-slot cache is sufficient.
+class WinEventActEvent : public QEvent
+{
+public:
+    WinEventActEvent() : QEvent(QEvent::WinEventAct) { }
+
+    void *operator new(std::size_t size)
+    {
+        if (void *storage = recycledStorage.fetchAndStoreAcquire(nullptr))
+            return storage;
+        return ::operator new(size);
+    }
+
+    void operator delete(void *storage)
+    {
+        if (!recycledStorage.testAndSetRelease(nullptr, storage))
+            ::operator delete(storage);
+    }
+
+private:
+    static QBasicAtomicPointer<void> recycledStorage;
+};
+
+QBasicAtomicPointer<void> WinEventActEvent::recycledStorage = Q_BASIC_ATOMIC_INITIALIZER(nullptr);
+
+QWindowsPipeWriter::QWindowsPipeWriter(HANDLE pipeWriteEnd, HandleOwnership handleOwnership,
+                                       QObject *parent)
     : QObject(parent),
       handle(pipeWriteEnd),
-      eventHandle(CreateEvent(NULL, FALSE, FALSE, NULL)),
-      syncHandle(CreateEvent(NULL, TRUE, FALSE, NULL)),
-      waitObject(NULL),
-      pendingBytesWrittenValue(0),
-      lastError(ERROR_SUCCESS),
-      stopped(true),
-      writeSequenceStarted(false),
-      bytesWrittenPending(false),
-      winEventActPosted(false)
-{
-    ZeroMemory(&overlapped, sizeof(OVERLAPPED));
-    overlapped.hEvent = eventHandle;
-    waitObject = CreateThreadpoolWait(waitCallback, this, NULL);
-    if (waitObject == NULL)
-        qErrnoWarning("QWindowsPipeWriter: CreateThreadpollWait failed.");
+      syncHandle(pipeWriterPool.isDestroyed() ? CreateEvent(NULL, TRUE, FALSE, NULL)
+                                              : pipeWriterPool->acquire()),
+      ownership(handleOwnership)
+{
+    if (handle != INVALID_HANDLE_VALUE)
+        createCompletionObject();
 }
 
 QWindowsPipeWriter::~QWindowsPipeWriter()
 {
     stop();
-    CloseThreadpoolWait(waitObject);
-    CloseHandle(eventHandle);
-    CloseHandle(syncHandle);
+    if (coalesceTimer)
+        CloseThreadpoolTimer(coalesceTimer);
+    if (ioObject)
+        CloseThreadpoolIo(ioObject);
+    if (waitObject)
+        CloseThreadpoolWait(waitObject);
+    if (eventHandle)
+        CloseHandle(eventHandle);
+    if (pipeWriterPool.isDestroyed())
+        CloseHandle(syncHandle);
+    else
+        pipeWriterPool->release(syncHandle);
+}
+
+/*!
+    Creates the object through which write completions are delivered.
+
+    For an exclusively owned handle, the handle is bound to the thread
+    pool, so that completions reach ioCompletionCallback() directly,
+    without the extra hop through an event object and a wait callback.
+    CreateThreadpoolIo() associates the handle itself with the thread
+    pool's completion port, so this is only safe while this writer issues
+    every overlapped operation on the handle; any other operation would
+    queue a completion packet without a matching StartThreadpoolIo().
+    QLocalSocket shares its duplex handle with QWindowsPipeReader, so
+    shared handles signal an event object instead and the result is
+    queried from a wait callback.
+ */
+void QWindowsPipeWriter::createCompletionObject()
+{
+    if (ownership == ExclusiveHandle) {
+        ioObject = CreateThreadpoolIo(handle, ioCompletionCallback, this, NULL);
+        if (ioObject == NULL) {
+            qErrnoWarning("QWindowsPipeWriter: CreateThreadpoolIo failed.");
+            return;
+        }
+
+        // When supported, synchronously completing writes do not queue a
+        // completion packet and are accounted for inline.
+        skipCompletionOnSuccess = SetFileCompletionNotificationModes(
+                handle, FILE_SKIP_COMPLETION_PORT_ON_SUCCESS | FILE_SKIP_SET_EVENT_ON_HANDLE);
+        return;
+    }
+
+    eventHandle = CreateEvent(NULL, FALSE, FALSE, NULL);
+    overlapped.hEvent = eventHandle;
+    waitObject = CreateThreadpoolWait(waitCallback, this, NULL);
+    if (waitObject == NULL)
+        qErrnoWarning("QWindowsPipeWriter: CreateThreadpoolWait failed.");
 }
 
 /*!
@@ -79,8 +206,10 @@ QWindowsPipeWriter::~QWindowsPipeWriter()
 void QWindowsPipeWriter::setHandle(HANDLE hPipeWriteEnd)
 {
     Q_ASSERT(!stopped);
+    Q_ASSERT(ioObject == nullptr && waitObject == nullptr);
 
     handle = hPipeWriteEnd;
+    createCompletionObject();
     QMutexLocker locker(&mutex);
     startAsyncWriteLocked(&locker);
 }
@@ -96,10 +225,12 @@ void QWindowsPipeWriter::stop()
 
     mutex.lock();
     stopped = true;
+    coalescePending = false;
     if (writeSequenceStarted) {
-        // Trying to disable callback before canceling the operation.
-        // Callback invocation is unnecessary here.
-        SetThreadpoolWait(waitObject, NULL, NULL);
+        // Trying to disable the wait callback before canceling the
+        // operation. Callback invocation is unnecessary here.
+        if (waitObject)
+            SetThreadpoolWait(waitObject, NULL, NULL);
         if (!CancelIoEx(handle, &overlapped)) {
             const DWORD dwError = GetLastError();
             if (dwError != ERROR_NOT_FOUND) {
@@ -111,16 +242,67 @@ void QWindowsPipeWriter::stop()
     }
     mutex.unlock();
 
-    WaitForThreadpoolWaitCallbacks(waitObject, TRUE);
+    if (coalesceTimer) {
+        SetThreadpoolTimer(coalesceTimer, NULL, 0, 0);
+        WaitForThreadpoolTimerCallbacks(coalesceTimer, TRUE);
+    }
+
+    if (waitObject)
+        WaitForThreadpoolWaitCallbacks(waitObject, TRUE);
+
+    // The canceled operation still delivers its completion packet; wait
+    // until the callback has observed 'stopped' and returned.
+    if (ioObject)
+        WaitForThreadpoolIoCallbacks(ioObject, FALSE);
 }
 
 /*!
     Returns the number of bytes that are waiting to be written.
  */
 qint64 QWindowsPipeWriter::bytesToWrite() const
+{
+    // Callers poll this from the producer thread while completions are
+    // processed on the thread pool; reading the atomic counter avoids
+    // serializing the two against each other.
+    return totalBytesToWrite.loadAcquire();
+}
+
+/*!
+    Sets the time, in microseconds, for which small writes are held back
+    in the hope of coalescing them with subsequent writes into a single
+    operation. A value of 0 (the default) disables coalescing; every
+    write is then submitted as soon as possible.
+ */
+void QWindowsPipeWriter::setCoalesceMicroseconds(int microseconds)
 {
     QMutexLocker locker(&mutex);
-    return writeBuffer.size() + pendingBytesWrittenValue;
+
+    if (microseconds > 0 && coalesceTimer == nullptr) {
+        coalesceTimer = CreateThreadpoolTimer(coalesceTimerCallback, this, NULL);
+        if (coalesceTimer == NULL) {
+            qErrnoWarning("QWindowsPipeWriter: CreateThreadpoolTimer failed.");
+            return;
+        }
+    }
+    coalesceUsec = microseconds;
+}
+
+/*!
+    Reserves a fixed-capacity staging buffer of at least \a capacity bytes
+    (rounded up to the next power of two). While it has room, small writes
+    are staged there without any allocation or chunk bookkeeping; overflow
+    falls back to the growable ring buffer, so writes keep succeeding when
+    the producer outpaces the pipe. Only the first call takes effect;
+    subsequent calls must not shrink the buffer below the capacity already
+    promised.
+ */
+void QWindowsPipeWriter::setBufferCapacity(qint64 capacity)
+{
+    Q_ASSERT(capacity > 0);
+
+    QMutexLocker locker(&mutex);
+    if (!fixedRing.isAllocated())
+        fixedRing.allocate(capacity);
 }
 
 /*!
@@ -131,6 +313,14 @@ void QWindowsPipeWriter::write(const QByteArray &ba)
     writeImpl(ba);
 }
 
+/*!
+    Writes \a ba to the internal buffer, taking ownership of its data.
+ */
+void QWindowsPipeWriter::write(QByteArray &&ba)
+{
+    writeImpl(std::move(ba));
+}
+
 /*!
     Writes data to the internal buffer.
  */
@@ -140,14 +330,15 @@ void QWindowsPipeWriter::write(const char *data, qint64 size)
 }
 
 template <typename... Args>
-inline void QWindowsPipeWriter::writeImpl(Args... args)
+inline void QWindowsPipeWriter::writeImpl(Args &&... args)
 {
     QMutexLocker locker(&mutex);
 
     if (lastError != ERROR_SUCCESS)
         return;
 
-    writeBuffer.append(args...);
+    appendToBuffer(std::forward<Args>(args)...);
+    updateTotalBytesToWrite();
 
     if (writeSequenceStarted)
         return;
@@ -156,8 +347,152 @@ inline void QWindowsPipeWriter::writeImpl(Args... args)
 
     // If we don't have an assigned handle yet, defer writing until
     // setHandle() is called.
-    if (handle != INVALID_HANDLE_VALUE)
-        startAsyncWriteLocked(&locker);
+    if (handle == INVALID_HANDLE_VALUE)
+        return;
+
+    // If enabled, hold small writes back briefly, so that a burst of them
+    // can be submitted as a single operation. A thread pool timer is used
+    // because the writer's thread may not run an event loop while it is
+    // producing data.
+    if (coalesceUsec > 0 && pendingArrays.isEmpty()
+        && ringSize() < minPassThroughSize) {
+        if (!coalescePending) {
+            coalescePending = true;
+            LARGE_INTEGER dueTime;
+            dueTime.QuadPart = -qint64(coalesceUsec) * 10; // relative, 100ns units
+            FILETIME dueFileTime;
+            dueFileTime.dwLowDateTime = dueTime.LowPart;
+            dueFileTime.dwHighDateTime = dueTime.HighPart;
+            SetThreadpoolTimer(coalesceTimer, &dueFileTime, 0, 0);
+        }
+        return;
+    }
+
+    startAsyncWriteLocked(&locker);
+}
+
+/*!
+    \internal
+    Thread pool timer callback; submits writes held back for coalescing.
+ */
+void QWindowsPipeWriter::coalesceTimerCallback(PTP_CALLBACK_INSTANCE instance, PVOID context,
+                                               PTP_TIMER timer)
+{
+    Q_UNUSED(instance);
+    Q_UNUSED(timer);
+    QWindowsPipeWriter *pipeWriter = reinterpret_cast<QWindowsPipeWriter *>(context);
+
+    QMutexLocker locker(&pipeWriter->mutex);
+    pipeWriter->coalescePending = false;
+    if (pipeWriter->stopped || pipeWriter->writeSequenceStarted)
+        return;
+    pipeWriter->startAsyncWriteLocked(&locker);
+}
+
+/*!
+    Queues the payload for writing. Large arrays are kept intact in the
+    pass-through queue, so that WriteFile() can read directly from their
+    storage; this is only possible while the ring buffer is empty, as the
+    pass-through queue is always drained first. Everything else goes
+    through the ring buffer for coalescing.
+ */
+void QWindowsPipeWriter::appendToBuffer(const QByteArray &ba)
+{
+    if (ba.size() >= minPassThroughSize && ringIsEmpty()) {
+        pendingArrays.append(ba);
+        pendingArraysSize += ba.size();
+    } else {
+        ringAppend(ba);
+    }
+}
+
+void QWindowsPipeWriter::appendToBuffer(QByteArray &&ba)
+{
+    if (ba.size() >= minPassThroughSize && ringIsEmpty()) {
+        pendingArraysSize += ba.size();
+        pendingArrays.append(std::move(ba));
+    } else {
+        ringAppend(ba);
+    }
+}
+
+void QWindowsPipeWriter::appendToBuffer(const char *data, qint64 size)
+{
+    // The caller does not guarantee the buffer's lifetime, so one copy is
+    // unavoidable; making it a single array keeps a big write in one piece
+    // for submission instead of chopping it into ring buffer chunks.
+    if (size >= minPassThroughSize && ringIsEmpty())
+        appendToBuffer(QByteArray(data, size));
+    else
+        ringAppend(data, size);
+}
+
+// The staging buffers form a strict FIFO across three containers: the
+// pass-through queue accepts data only while both rings are empty, and the
+// fixed ring only while the growable ring buffer is empty. Consumption
+// drains them in the same order (queue, fixed ring, ring buffer), so bytes
+// never overtake each other.
+
+void QWindowsPipeWriter::ringAppend(const QByteArray &ba)
+{
+    if (fixedRing.isAllocated() && writeBuffer.isEmpty())
+        ringAppend(ba.constData(), ba.size());
+    else
+        writeBuffer.append(ba);
+}
+
+void QWindowsPipeWriter::ringAppend(const char *data, qint64 size)
+{
+    if (fixedRing.isAllocated() && writeBuffer.isEmpty()) {
+        const qint64 appended = fixedRing.append(data, size);
+        data += appended;
+        size -= appended;
+    }
+    if (size > 0)
+        writeBuffer.append(data, size);
+}
+
+qint64 QWindowsPipeWriter::ringSize() const
+{
+    return fixedRing.size() + writeBuffer.size();
+}
+
+bool QWindowsPipeWriter::ringIsEmpty() const
+{
+    return fixedRing.isEmpty() && writeBuffer.isEmpty();
+}
+
+const char *QWindowsPipeWriter::ringReadPointer() const
+{
+    return fixedRing.isEmpty() ? writeBuffer.readPointer() : fixedRing.readPointer();
+}
+
+qint64 QWindowsPipeWriter::ringNextDataBlockSize() const
+{
+    return fixedRing.isEmpty() ? writeBuffer.nextDataBlockSize()
+                               : fixedRing.nextDataBlockSize();
+}
+
+qint64 QWindowsPipeWriter::ringPeek(char *data, qint64 maxLength) const
+{
+    const qint64 fromFixed = fixedRing.peek(data, maxLength);
+    if (fromFixed == maxLength)
+        return fromFixed;
+    return fromFixed + writeBuffer.peek(data + fromFixed, maxLength - fromFixed);
+}
+
+void QWindowsPipeWriter::ringFree(qint64 bytes)
+{
+    const qint64 fromFixed = qMin(bytes, fixedRing.size());
+    fixedRing.free(fromFixed);
+    if (bytes > fromFixed)
+        writeBuffer.free(bytes - fromFixed);
+}
+
+void QWindowsPipeWriter::ringClear()
+{
+    fixedRing.clear();
+    writeBuffer.clear();
 }
 
 /*!
@@ -165,23 +500,73 @@ inline void QWindowsPipeWriter::writeImpl(Args... args)
  */
 void QWindowsPipeWriter::startAsyncWriteLocked(QMutexLocker<QMutex> *locker)
 {
-    while (!writeBuffer.isEmpty()) {
-        // WriteFile() returns true, if the write operation completes synchronously.
-        // We don't need to call GetOverlappedResult() additionally, because
-        // 'numberOfBytesWritten' is valid in this case.
+    // An explicit flush supersedes a scheduled coalescing timeout.
+    coalescePending = false;
+
+    while (!pendingArrays.isEmpty() || !ringIsEmpty()) {
+        const char *writePointer;
+        qint64 writeSize;
+        if (!pendingArrays.isEmpty()) {
+            // Submit large arrays directly from their own storage.
+            const QByteArray &front = pendingArrays.first();
+            writePointer = front.constData() + frontArrayOffset;
+            writeSize = front.size() - frontArrayOffset;
+        } else {
+            writePointer = ringReadPointer();
+            writeSize = ringNextDataBlockSize();
+
+            // A burst of small writes leaves several blocks in the staging
+            // buffers, and submitting them one by one costs a kernel
+            // transition per block. Flatten them into a single WriteFile()
+            // call instead. Gather I/O (WriteFileGather()) is not an option
+            // here, as it requires a handle opened with
+            // FILE_FLAG_NO_BUFFERING and page-aligned segments.
+            if (writeSize < ringSize()) {
+                const qint64 gatherSize = qMin(ringSize(), maxGatherSize);
+                if (gatherBuffer.size() < gatherSize)
+                    gatherBuffer.resize(gatherSize);
+                ringPeek(gatherBuffer.data(), gatherSize);
+                writePointer = gatherBuffer.constData();
+                writeSize = gatherSize;
+            }
+        }
+
+        if (ioObject)
+            StartThreadpoolIo(ioObject);
+
         DWORD numberOfBytesWritten;
         DWORD errorCode = ERROR_SUCCESS;
-        if (!WriteFile(handle, writeBuffer.readPointer(), writeBuffer.nextDataBlockSize(),
+        if (!WriteFile(handle, writePointer, writeSize,
                        &numberOfBytesWritten, &overlapped)) {
             errorCode = GetLastError();
             if (errorCode == ERROR_IO_PENDING) {
                 // Operation has been queued and will complete in the future.
                 writeSequenceStarted = true;
-                SetThreadpoolWait(waitObject, eventHandle, NULL);
+                if (waitObject)
+                    SetThreadpoolWait(waitObject, eventHandle, NULL);
                 break;
             }
+            // The write failed right away; no completion packet will be
+            // queued for it.
+            if (ioObject)
+                CancelThreadpoolIo(ioObject);
+        } else if (ioObject) {
+            if (!skipCompletionOnSuccess) {
+                // The write completed synchronously, but a completion
+                // packet is still queued; let the callback do the
+                // accounting.
+                writeSequenceStarted = true;
+                break;
+            }
+            // Completion packets for successful synchronous writes are
+            // disabled; 'numberOfBytesWritten' is valid and the result is
+            // accounted for inline.
+            CancelThreadpoolIo(ioObject);
         }
 
+        // In the event-based mode, no wait was armed for a synchronous
+        // completion; 'numberOfBytesWritten' is valid and the result is
+        // accounted for inline as well.
         if (!writeCompleted(errorCode, numberOfBytesWritten))
             break;
     }
@@ -190,10 +575,16 @@ void QWindowsPipeWriter::startAsyncWriteLocked(QMutexLocker<QMutex> *locker)
     if (!bytesWrittenPending)
         return;
 
+    // Even when the write completed synchronously on the writer's own
+    // thread, the signal must go through the event loop: emitting it here
+    // would consume the pending byte count inside write(), and the
+    // blocking waiters (QProcess::waitForBytesWritten() and
+    // QLocalSocket's socket poller) treat "nothing pending" right after a
+    // write() as failure.
     if (!winEventActPosted) {
         winEventActPosted = true;
         locker->unlock();
-        QCoreApplication::postEvent(this, new QEvent(QEvent::WinEventAct));
+        QCoreApplication::postEvent(this, new WinEventActEvent);
     } else {
         locker->unlock();
     }
@@ -205,7 +596,31 @@ void QWindowsPipeWriter::startAsyncWriteLocked(QMutexLocker<QMutex> *locker)
 
 /*!
     \internal
-    Thread pool callback procedure.
+    Thread pool I/O completion callback, used for exclusively owned
+    handles. The result of the asynchronous operation is delivered with
+    the completion packet, so no additional call to GetOverlappedResult()
+    is needed. 'ioResult' is already a Win32 error code rather than a raw
+    NTSTATUS (the thread pool converts it before invoking the callback),
+    so no RtlNtStatusToDosError() translation is needed either.
+ */
+void QWindowsPipeWriter::ioCompletionCallback(PTP_CALLBACK_INSTANCE instance, PVOID context,
+                                              PVOID overlappedPtr, ULONG ioResult,
+                                              ULONG_PTR numberOfBytesTransfered, PTP_IO io)
+{
+    Q_UNUSED(instance);
+    Q_UNUSED(overlappedPtr);
+    Q_UNUSED(io);
+    QWindowsPipeWriter *pipeWriter = reinterpret_cast<QWindowsPipeWriter *>(context);
+
+    pipeWriter->completionNotified(ioResult, DWORD(numberOfBytesTransfered));
+}
+
+/*!
+    \internal
+    Thread pool wait callback, used for shared handles. Runs when the
+    wait on the overlapped event is satisfied; unlike the I/O completion
+    callback, the result of the operation has to be queried with
+    GetOverlappedResult() here.
  */
 void QWindowsPipeWriter::waitCallback(PTP_CALLBACK_INSTANCE instance, PVOID context,
                                       PTP_WAIT wait, TP_WAIT_RESULT waitResult)
@@ -222,25 +637,34 @@ void QWindowsPipeWriter::waitCallback(PTP_CALLBACK_INSTANCE instance, PVOID cont
                              &numberOfBytesTransfered, FALSE))
         errorCode = GetLastError();
 
-    QMutexLocker locker(&pipeWriter->mutex);
+    pipeWriter->completionNotified(errorCode, numberOfBytesTransfered);
+}
+
+/*!
+    \internal
+    Handles a write completion on a thread pool thread.
+ */
+void QWindowsPipeWriter::completionNotified(DWORD errorCode, DWORD numberOfBytesWritten)
+{
+    QMutexLocker locker(&mutex);
 
     // After the writer was stopped, the only reason why this function can be called is the
     // completion of a cancellation. No signals should be emitted, and no new write sequence
     // should be started in this case.
-    if (pipeWriter->stopped)
+    if (stopped)
         return;
 
-    pipeWriter->writeSequenceStarted = false;
+    writeSequenceStarted = false;
 
-    if (pipeWriter->writeCompleted(errorCode, numberOfBytesTransfered)) {
-        pipeWriter->startAsyncWriteLocked(&locker);
+    if (writeCompleted(errorCode, numberOfBytesWritten)) {
+        startAsyncWriteLocked(&locker);
     } else {
         // The write operation failed, so we must unblock the main thread,
         // which can wait for the event. We set the event only after unlocking
         // to avoid additional context switches due to the released thread
         // immediately running into the lock.
         locker.unlock();
-        SetEvent(pipeWriter->syncHandle);
+        SetEvent(syncHandle);
     }
 }
 
@@ -253,12 +677,26 @@ bool QWindowsPipeWriter::writeCompleted(DWORD errorCode, DWORD numberOfBytesWrit
     if (errorCode == ERROR_SUCCESS) {
         bytesWrittenPending = true;
         pendingBytesWrittenValue += numberOfBytesWritten;
-        writeBuffer.free(numberOfBytesWritten);
+        if (!pendingArrays.isEmpty()) {
+            pendingArraysSize -= numberOfBytesWritten;
+            frontArrayOffset += numberOfBytesWritten;
+            if (frontArrayOffset == pendingArrays.first().size()) {
+                pendingArrays.removeFirst();
+                frontArrayOffset = 0;
+            }
+        } else {
+            ringFree(numberOfBytesWritten);
+        }
+        updateTotalBytesToWrite();
         return true;
     }
 
     lastError = errorCode;
-    writeBuffer.clear();
+    ringClear();
+    pendingArrays.clear();
+    pendingArraysSize = 0;
+    frontArrayOffset = 0;
+    updateTotalBytesToWrite();
     switch (errorCode) {
     case ERROR_PIPE_NOT_CONNECTED: // the other end has closed the pipe
     case ERROR_OPERATION_ABORTED: // the operation was canceled
@@ -286,6 +724,11 @@ bool QWindowsPipeWriter::event(QEvent *e)
 /*!
     Updates the state and emits pending signals in the main thread.
     Returns \c true, if bytesWritten() was emitted.
+
+    Emissions are coalesced: completions that accrue while a signal is
+    being delivered (typically because a connected slot issues further
+    writes) are drained by the same call instead of taking another event
+    loop round trip each, up to \c maxEmitCycles per call.
  */
 bool QWindowsPipeWriter::consumePendingAndEmit(bool allowWinActPosting)
 {
@@ -296,23 +739,56 @@ bool QWindowsPipeWriter::consumePendingAndEmit(bool allowWinActPosting)
     if (allowWinActPosting)
         winEventActPosted = false;
 
-    if (!bytesWrittenPending)
-        return false;
+    // The connected slots may delete the writer while a signal is being
+    // delivered (QProcess and QLocalSocket both destroy it when the write
+    // channel is closed from a bytesWritten() handler). In that case the
+    // pooled syncHandle may already have been re-acquired by another
+    // writer, so not even ResetEvent() may run afterwards; the guard must
+    // be checked before any member is touched again.
+    QPointer<QWindowsPipeWriter> alive(this);
+    bool emitted = false;
+    for (int cycle = 0; cycle < maxEmitCycles; ++cycle) {
+        if (!bytesWrittenPending)
+            return emitted;
+
+        // Reset the state even if we don't emit bytesWritten().
+        // It's a defined behavior to not re-emit this signal recursively.
+        bytesWrittenPending = false;
+        qint64 numberOfBytesWritten = pendingBytesWrittenValue;
+        pendingBytesWrittenValue = 0;
+        updateTotalBytesToWrite();
+
+        // Disable any further processing, if the pipe was stopped.
+        if (stopped)
+            return emitted;
+
+        // Block event posting and inline emission while the signal is being
+        // delivered; completions of nested writes are accumulated and
+        // consumed by the next iteration.
+        const bool savedWinEventActPosted = winEventActPosted;
+        winEventActPosted = true;
+        locker.unlock();
 
-    // Reset the state even if we don't emit bytesWritten().
-    // It's a defined behavior to not re-emit this signal recursively.
-    bytesWrittenPending = false;
-    qint64 numberOfBytesWritten = pendingBytesWrittenValue;
-    pendingBytesWrittenValue = 0;
+        emit bytesWritten(numberOfBytesWritten);
+        emitted = true;
 
-    locker.unlock();
+        if (alive.isNull())
+            return emitted;
 
-    // Disable any further processing, if the pipe was stopped.
-    if (stopped)
-        return false;
+        ResetEvent(syncHandle);
+        locker.relock();
+        winEventActPosted = savedWinEventActPosted;
+    }
 
-    emit bytesWritten(numberOfBytesWritten);
-    return true;
+    // More completions arrived than the cap allows to deliver here; hand
+    // the remainder to the event loop.
+    if (bytesWrittenPending && !winEventActPosted && !stopped) {
+        winEventActPosted = true;
+        locker.unlock();
+        QCoreApplication::postEvent(this, new WinEventActEvent);
+        SetEvent(syncHandle);
+    }
+    return emitted;
 }
 
 QT_END_NAMESPACE
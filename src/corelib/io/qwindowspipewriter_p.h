@@ -54,22 +54,100 @@
 
 #include <qobject.h>
 #include <qmutex.h>
+#include <qatomic.h>
 #include <private/qringbuffer_p.h>
 
 #include <qt_windows.h>
 
 QT_BEGIN_NAMESPACE
 
+// A single-allocation ring buffer with a power-of-two capacity and masked
+// head/tail indices. Unlike QRingBuffer it never allocates on append, at
+// the cost of a fixed capacity. QWindowsPipeWriter uses it as the staging
+// area for small writes when the caller has bounded its buffering via
+// setBufferCapacity().
+class QFixedRingBuffer
+{
+public:
+    void allocate(qint64 capacity)
+    {
+        Q_ASSERT(isEmpty());
+        qint64 powerOfTwo = 64;
+        while (powerOfTwo < capacity)
+            powerOfTwo *= 2;
+        m_buffer.resize(powerOfTwo);
+        m_mask = powerOfTwo - 1;
+        m_head = m_tail = 0;
+    }
+
+    bool isAllocated() const { return !m_buffer.isEmpty(); }
+    qint64 capacity() const { return m_buffer.size(); }
+    qint64 size() const { return m_tail - m_head; }
+    bool isEmpty() const { return m_tail == m_head; }
+
+    // Appends as much of the data as fits and returns the appended size.
+    qint64 append(const char *data, qint64 size)
+    {
+        const qint64 n = qMin(size, capacity() - this->size());
+        const qint64 tailOffset = m_tail & m_mask;
+        const qint64 untilWrap = qMin(n, capacity() - tailOffset);
+        memcpy(m_buffer.data() + tailOffset, data, untilWrap);
+        memcpy(m_buffer.data(), data + untilWrap, n - untilWrap);
+        m_tail += n;
+        return n;
+    }
+
+    const char *readPointer() const { return m_buffer.constData() + (m_head & m_mask); }
+    qint64 nextDataBlockSize() const { return qMin(size(), capacity() - (m_head & m_mask)); }
+
+    qint64 peek(char *data, qint64 maxLength) const
+    {
+        const qint64 n = qMin(maxLength, size());
+        const qint64 headOffset = m_head & m_mask;
+        const qint64 untilWrap = qMin(n, capacity() - headOffset);
+        memcpy(data, m_buffer.constData() + headOffset, untilWrap);
+        memcpy(data + untilWrap, m_buffer.constData(), n - untilWrap);
+        return n;
+    }
+
+    void free(qint64 bytes)
+    {
+        Q_ASSERT(bytes <= size());
+        m_head += bytes;
+    }
+
+    void clear() { m_head = m_tail = 0; }
+
+private:
+    QByteArray m_buffer;
+    qint64 m_mask = 0;
+    qint64 m_head = 0;
+    qint64 m_tail = 0;
+};
+
 class Q_CORE_EXPORT QWindowsPipeWriter : public QObject
 {
     Q_OBJECT
 public:
-    explicit QWindowsPipeWriter(HANDLE pipeWriteEnd, QObject *parent = nullptr);
+    // Declares whether this writer is the only issuer of overlapped I/O
+    // on the handle. Exclusively owned handles get their completions
+    // delivered through a thread pool I/O object; that binds the handle
+    // itself to the thread pool, so it must not be used when someone else
+    // (e.g. QWindowsPipeReader on a duplex pipe) also performs overlapped
+    // operations on the same handle.
+    enum HandleOwnership { SharedHandle, ExclusiveHandle };
+
+    explicit QWindowsPipeWriter(HANDLE pipeWriteEnd,
+                                HandleOwnership handleOwnership = SharedHandle,
+                                QObject *parent = nullptr);
     ~QWindowsPipeWriter();
 
     void setHandle(HANDLE hPipeWriteEnd);
     void write(const QByteArray &ba);
+    void write(QByteArray &&ba);
     void write(const char *data, qint64 size);
+    void setCoalesceMicroseconds(int microseconds);
+    void setBufferCapacity(qint64 capacity);
     void stop();
     bool checkForWrite() { return consumePendingAndEmit(false); }
     qint64 bytesToWrite() const;
@@ -83,27 +161,68 @@ protected:
 
 private:
     template <typename... Args>
-    inline void writeImpl(Args... args);
+    inline void writeImpl(Args &&... args);
+
+    void appendToBuffer(const QByteArray &ba);
+    void appendToBuffer(QByteArray &&ba);
+    void appendToBuffer(const char *data, qint64 size);
 
+    void ringAppend(const QByteArray &ba);
+    void ringAppend(const char *data, qint64 size);
+    qint64 ringSize() const;
+    bool ringIsEmpty() const;
+    const char *ringReadPointer() const;
+    qint64 ringNextDataBlockSize() const;
+    qint64 ringPeek(char *data, qint64 maxLength) const;
+    void ringFree(qint64 bytes);
+    void ringClear();
+
+    void createCompletionObject();
     void startAsyncWriteLocked(QMutexLocker<QMutex> *locker);
+    static void CALLBACK ioCompletionCallback(PTP_CALLBACK_INSTANCE instance, PVOID context,
+                                              PVOID overlappedPtr, ULONG ioResult,
+                                              ULONG_PTR numberOfBytesTransfered, PTP_IO io);
     static void CALLBACK waitCallback(PTP_CALLBACK_INSTANCE instance, PVOID context,
                                       PTP_WAIT wait, TP_WAIT_RESULT waitResult);
+    static void CALLBACK coalesceTimerCallback(PTP_CALLBACK_INSTANCE instance, PVOID context,
+                                               PTP_TIMER timer);
+    void completionNotified(DWORD errorCode, DWORD numberOfBytesWritten);
     bool writeCompleted(DWORD errorCode, DWORD numberOfBytesWritten);
     bool consumePendingAndEmit(bool allowWinActPosting);
 
+    // Keeps the lock-free view of bytesToWrite() in sync with the buffer
+    // state. Must be called with the mutex held.
+    void updateTotalBytesToWrite()
+    {
+        totalBytesToWrite.storeRelease(fixedRing.size() + writeBuffer.size()
+                                       + pendingArraysSize + pendingBytesWrittenValue);
+    }
+
     HANDLE handle;
-    HANDLE eventHandle;
+    HANDLE eventHandle = nullptr;
     HANDLE syncHandle;
-    PTP_WAIT waitObject;
-    OVERLAPPED overlapped;
+    HandleOwnership ownership;
+    PTP_IO ioObject = nullptr;
+    PTP_WAIT waitObject = nullptr;
+    PTP_TIMER coalesceTimer = nullptr;
+    OVERLAPPED overlapped = {};
+    QFixedRingBuffer fixedRing;
     QRingBuffer writeBuffer;
-    qint64 pendingBytesWrittenValue;
+    QByteArray gatherBuffer;
+    QList<QByteArray> pendingArrays;
+    qint64 pendingArraysSize = 0;
+    qint64 frontArrayOffset = 0;
+    qint64 pendingBytesWrittenValue = 0;
+    QAtomicInteger<qint64> totalBytesToWrite = 0;
     mutable QMutex mutex;
-    DWORD lastError;
-    bool stopped;
-    bool writeSequenceStarted;
-    bool bytesWrittenPending;
-    bool winEventActPosted;
+    DWORD lastError = ERROR_SUCCESS;
+    int coalesceUsec = 0;
+    bool coalescePending = false;
+    bool stopped = true;
+    bool writeSequenceStarted = false;
+    bool bytesWrittenPending = false;
+    bool winEventActPosted = false;
+    bool skipCompletionOnSuccess = false;
 };
 
 QT_END_NAMESPACE
@@ -307,7 +307,9 @@ qint64 QLocalSocket::writeData(const char *data, qint64 len)
         return 0;
 
     if (!d->pipeWriter) {
-        d->pipeWriter = new QWindowsPipeWriter(d->handle, this);
+        // The duplex handle is shared with the pipe reader, so the writer
+        // must not bind it to the thread pool.
+        d->pipeWriter = new QWindowsPipeWriter(d->handle, QWindowsPipeWriter::SharedHandle, this);
         QObjectPrivate::connect(d->pipeWriter, &QWindowsPipeWriter::bytesWritten,
                                 d, &QLocalSocketPrivate::_q_bytesWritten);
     }
@@ -40,6 +40,8 @@
 #include "qoffscreenintegration_x11.h"
 
 #include <QByteArray>
+#include <QHash>
+#include <QMutex>
 #include <QOpenGLContext>
 
 #include <X11/Xlib.h>
@@ -52,28 +54,46 @@
 
 QT_BEGIN_NAMESPACE
 
+// XInitThreads() must precede any other Xlib call in the process. Running
+// it when the plugin is loaded guarantees that, keeps it out of the
+// connection constructor (which may be reached from multiple threads via
+// createPlatformOpenGLContext()), and makes sure it runs exactly once.
+static void initializeXThreads()
+{
+    XInitThreads();
+}
+Q_CONSTRUCTOR_FUNCTION(initializeXThreads)
+
 class QOffscreenX11Info
 {
 public:
+    // The connection is fully set up by the time this is constructed (see
+    // QOffscreenX11Connection::x11Info()), so the display, root window and
+    // screen number can be resolved once instead of re-deriving them on
+    // every GLX call.
     QOffscreenX11Info(QOffscreenX11Connection *connection)
-        : m_connection(connection)
+        : m_display((Display *)connection->display()),
+          m_root(DefaultRootWindow(m_display)),
+          m_screen(connection->screenNumber())
     {
     }
 
     Display *display() const {
-        return (Display *)m_connection->display();
+        return m_display;
     }
 
     Window root() const {
-        return DefaultRootWindow(display());
+        return m_root;
     }
 
     int screenNumber() const {
-        return m_connection->screenNumber();
+        return m_screen;
     }
 
 private:
-    QOffscreenX11Connection *m_connection;
+    Display *m_display;
+    Window m_root;
+    int m_screen;
 };
 
 QOffscreenX11Integration::QOffscreenX11Integration(const QStringList& paramList)
@@ -127,7 +147,9 @@ QOffscreenX11PlatformNativeInterface::~QOffscreenX11PlatformNativeInterface() =
 void *QOffscreenX11PlatformNativeInterface::nativeResourceForScreen(const QByteArray &resource, QScreen *screen)
 {
     Q_UNUSED(screen);
-    if (resource.toLower() == QByteArrayLiteral("display") ) {
+    // Compare case-insensitively in place; toLower() would allocate a
+    // lowercased copy on every query.
+    if (qstricmp(resource.constData(), "display") == 0) {
         if (!m_connection)
             m_connection.reset(new QOffscreenX11Connection);
         return m_connection->display();
@@ -137,14 +159,14 @@ void *QOffscreenX11PlatformNativeInterface::nativeResourceForScreen(const QByteA
 
 #if !defined(QT_NO_OPENGL) && QT_CONFIG(xcb_glx_plugin)
 void *QOffscreenX11PlatformNativeInterface::nativeResourceForContext(const QByteArray &resource, QOpenGLContext *context) {
-    if (resource.toLower() == QByteArrayLiteral("glxconfig") ) {
+    if (qstricmp(resource.constData(), "glxconfig") == 0) {
         if (context) {
             QOffscreenX11GLXContext *glxPlatformContext = static_cast<QOffscreenX11GLXContext *>(context->handle());
             if (glxPlatformContext)
                 return glxPlatformContext->glxConfig();
         }
     }
-    if (resource.toLower() == QByteArrayLiteral("glxcontext") ) {
+    if (qstricmp(resource.constData(), "glxcontext") == 0) {
         if (context) {
             QOffscreenX11GLXContext *glxPlatformContext = static_cast<QOffscreenX11GLXContext *>(context->handle());
             if (glxPlatformContext)
@@ -157,8 +179,6 @@ void *QOffscreenX11PlatformNativeInterface::nativeResourceForContext(const QByte
 
 QOffscreenX11Connection::QOffscreenX11Connection()
 {
-    XInitThreads();
-
     QByteArray displayName = qgetenv("DISPLAY");
     Display *display = XOpenDisplay(displayName.constData());
     m_display = display;
@@ -188,8 +208,32 @@ public:
     GLXContext shareContext = nullptr;
     GLXFBConfig config = nullptr;
     Window window = 0;
+    bool sharedWindow = false;
+    QSize lastWindowSize;
+};
+
+// Contexts created for the same (display, config) pair share one dummy
+// window, so constructing another context avoids a window creation on the
+// server, and makeCurrent() can skip the resize when the size is
+// unchanged. The window is only ever bound to one context at a time
+// (tracked via boundContext); a context that finds it bound elsewhere
+// falls back to a private window, so concurrently current contexts - the
+// plugin advertises ThreadedOpenGL - never fight over one drawable's
+// size.
+struct DummyWindowEntry
+{
+    Window window = 0;
+    int refCount = 0;
+    QSize lastSize;
+    const QOffscreenX11GLXContext *boundContext = nullptr;
 };
 
+typedef QPair<Display *, GLXFBConfig> DummyWindowKey;
+typedef QHash<DummyWindowKey, DummyWindowEntry> DummyWindowCache;
+
+Q_GLOBAL_STATIC(DummyWindowCache, dummyWindowCache)
+static QBasicMutex dummyWindowMutex;
+
 static Window createDummyWindow(QOffscreenX11Info *x11, XVisualInfo *visualInfo)
 {
     Colormap cmap = XCreateColormap(x11->display(), x11->root(), visualInfo->visual, AllocNone);
@@ -217,6 +261,35 @@ static Window createDummyWindow(QOffscreenX11Info *x11, GLXFBConfig config)
     return window;
 }
 
+static Window acquireDummyWindow(QOffscreenX11Info *x11, GLXFBConfig config)
+{
+    QMutexLocker lock(&dummyWindowMutex);
+    DummyWindowEntry &entry = (*dummyWindowCache())[DummyWindowKey(x11->display(), config)];
+    if (entry.refCount == 0) {
+        entry.window = createDummyWindow(x11, config);
+        entry.lastSize = QSize(100, 100);
+    }
+    ++entry.refCount;
+    return entry.window;
+}
+
+static void releaseDummyWindow(Display *display, GLXFBConfig config,
+                               const QOffscreenX11GLXContext *context)
+{
+    if (dummyWindowCache.isDestroyed())
+        return;
+    QMutexLocker lock(&dummyWindowMutex);
+    const auto it = dummyWindowCache()->find(DummyWindowKey(display, config));
+    if (it == dummyWindowCache()->end())
+        return;
+    if (it->boundContext == context)
+        it->boundContext = nullptr;
+    if (--it->refCount == 0) {
+        XDestroyWindow(display, it->window);
+        dummyWindowCache()->erase(it);
+    }
+}
+
 QOffscreenX11GLXContext::QOffscreenX11GLXContext(QOffscreenX11Info *x11, QOpenGLContext *context)
     : d(new QOffscreenX11GLXContextData)
 {
@@ -249,8 +322,10 @@ QOffscreenX11GLXContext::QOffscreenX11GLXContext(QOffscreenX11Info *x11, QOpenGL
         if (d->context)
             qglx_surfaceFormatFromGLXFBConfig(&d->format, x11->display(), config);
 
-        // Create a temporary window so that we can make the new context current
-        d->window = createDummyWindow(x11, config);
+        // Use a temporary window so that we can make the new context current;
+        // contexts created for the same config share one.
+        d->window = acquireDummyWindow(x11, config);
+        d->sharedWindow = true;
     } else {
         XVisualInfo *visualInfo = qglx_findVisualInfo(x11->display(), 0, &d->format);
         if (Q_UNLIKELY(!visualInfo))
@@ -263,6 +338,7 @@ QOffscreenX11GLXContext::QOffscreenX11GLXContext(QOffscreenX11Info *x11, QOpenGL
         }
 
         d->window = createDummyWindow(x11, visualInfo);
+        d->lastWindowSize = QSize(100, 100);
         XFree(visualInfo);
     }
 }
@@ -270,15 +346,51 @@ QOffscreenX11GLXContext::QOffscreenX11GLXContext(QOffscreenX11Info *x11, QOpenGL
 QOffscreenX11GLXContext::~QOffscreenX11GLXContext()
 {
     glXDestroyContext(d->x11->display(), d->context);
-    XDestroyWindow(d->x11->display(), d->window);
+    if (d->sharedWindow)
+        releaseDummyWindow(d->x11->display(), d->config, this);
+    else
+        XDestroyWindow(d->x11->display(), d->window);
 }
 
 bool QOffscreenX11GLXContext::makeCurrent(QPlatformSurface *surface)
 {
     QSize size = surface->surface()->size();
 
-    XResizeWindow(d->x11->display(), d->window, size.width(), size.height());
-    XSync(d->x11->display(), true);
+    // Skip the resize whenever the window already has the right size. When
+    // it is needed, flushing the request is sufficient: requests on a
+    // connection are processed in order, and glXMakeCurrent() serializes
+    // against the server itself, so a full XSync() round trip - which on a
+    // remote display costs a network round trip per makeCurrent() - is not
+    // required. (The old XSync(.., True) additionally discarded the event
+    // queue, but the dummy window selects no events, so there is nothing
+    // to discard.)
+    if (d->sharedWindow) {
+        QMutexLocker lock(&dummyWindowMutex);
+        DummyWindowEntry &entry =
+                (*dummyWindowCache())[DummyWindowKey(d->x11->display(), d->config)];
+        if (!entry.boundContext || entry.boundContext == this) {
+            entry.boundContext = this;
+            if (entry.lastSize != size) {
+                XResizeWindow(d->x11->display(), d->window, size.width(), size.height());
+                XFlush(d->x11->display());
+                entry.lastSize = size;
+            }
+        } else {
+            // The shared window is bound to another context, presumably on
+            // another thread; detach permanently to a private window rather
+            // than sharing a drawable between concurrently current contexts.
+            lock.unlock();
+            releaseDummyWindow(d->x11->display(), d->config, this);
+            d->window = createDummyWindow(d->x11, d->config);
+            d->sharedWindow = false;
+            d->lastWindowSize = QSize(100, 100);
+        }
+    }
+    if (!d->sharedWindow && d->lastWindowSize != size) {
+        XResizeWindow(d->x11->display(), d->window, size.width(), size.height());
+        XFlush(d->x11->display());
+        d->lastWindowSize = size;
+    }
 
     if (glXMakeCurrent(d->x11->display(), d->window, d->context)) {
         glViewport(0, 0, size.width(), size.height());
@@ -291,6 +403,13 @@ bool QOffscreenX11GLXContext::makeCurrent(QPlatformSurface *surface)
 void QOffscreenX11GLXContext::doneCurrent()
 {
     glXMakeCurrent(d->x11->display(), 0, nullptr);
+
+    if (d->sharedWindow && !dummyWindowCache.isDestroyed()) {
+        QMutexLocker lock(&dummyWindowMutex);
+        const auto it = dummyWindowCache()->find(DummyWindowKey(d->x11->display(), d->config));
+        if (it != dummyWindowCache()->end() && it->boundContext == this)
+            it->boundContext = nullptr;
+    }
 }
 
 void QOffscreenX11GLXContext::swapBuffers(QPlatformSurface *)
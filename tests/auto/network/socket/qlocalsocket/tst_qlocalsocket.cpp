@@ -121,6 +121,7 @@ private slots:
     void waitForDisconnectByServer();
     void waitForReadyReadOnDisconnected();
     void delayedDisconnect();
+    void disconnectFromBytesWrittenSlot();
 
     void removeServer();
 
@@ -1375,6 +1376,38 @@ void tst_QLocalSocket::delayedDisconnect()
     QVERIFY(socket.isOpen());
 }
 
+// Disconnecting from a slot connected to bytesWritten() destroys the
+// socket's internal pipe writer on Windows while its signal is still
+// being delivered; the emission must be safe against that.
+void tst_QLocalSocket::disconnectFromBytesWrittenSlot()
+{
+    QString name = "tst_localsocket";
+    LocalServer server;
+    QVERIFY(server.listen(name));
+    LocalSocket socket;
+    socket.connectToServer(name);
+    QVERIFY(socket.waitForConnected(3000));
+    QVERIFY(server.waitForNewConnection(3000));
+    QLocalSocket *serverSocket = server.nextPendingConnection();
+    QVERIFY(serverSocket);
+
+    connect(&socket, &QLocalSocket::bytesWritten, [&socket]() {
+        socket.disconnectFromServer();
+    });
+
+    const QByteArray data(64 * 1024, 'a');
+    QCOMPARE(socket.write(data), qint64(data.size()));
+    QVERIFY(socket.waitForDisconnected(3000));
+    QCOMPARE(socket.state(), QLocalSocket::UnconnectedState);
+
+    QByteArray received;
+    while (received.size() < data.size()) {
+        QVERIFY(serverSocket->waitForReadyRead(3000));
+        received.append(serverSocket->readAll());
+    }
+    QCOMPARE(received, data);
+}
+
 void tst_QLocalSocket::removeServer()
 {
     // this is a hostile takeover, but recovering from a crash results in the same